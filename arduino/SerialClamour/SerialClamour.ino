@@ -1,5 +1,15 @@
-
-unsigned char fftData[30];
+// Frame layout sent by Clamour:
+//   0xFF sync, sequence, sample position (4 bytes), latency ms (2 bytes), one byte (0-254) per band
+// Header fields are 7 bits per byte, LSB first. They wrap: sequence is modulo 128 and
+// sample position modulo 2^28 (~101 minutes at 44.1kHz), so compare with modular differences.
+const int numBands = 29;
+const int headerSize = 7; // excluding the sync byte
+
+unsigned char header[headerSize];
+unsigned char fftData[numBands];
+unsigned char sequence;
+unsigned long samplePosition;
+unsigned int latencyMs;
 
 void setup() {
   Serial.begin(115200);
@@ -10,21 +20,31 @@ void setup() {
 }
 
 void loop() {
-  
 
 
-  
+
+
 }
 
 void serialEvent() {
   while (Serial.available()) {
 
-      int numBytes = Serial.readBytes(fftData, 30);
+      // Resync on the start of a frame
+      if (Serial.read() != 0xFF) continue;
+
+      if (Serial.readBytes(header, headerSize) != headerSize) return;
+      sequence = header[0];
+      samplePosition = 0;
+      for (int i = 0; i < 4; i++) {
+        samplePosition |= (unsigned long)header[1 + i] << (7 * i);
+      }
+      latencyMs = header[5] | (header[6] << 7);
+
+      int numBytes = Serial.readBytes(fftData, numBands);
       //Serial.write(fftData,numBytes); //send data back for verification
-      
 
-    
+
+
   }
 
 }
-  
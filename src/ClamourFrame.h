@@ -0,0 +1,32 @@
+#pragma once
+
+#include "SpectralFeatures.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Analysis of one spectrum. Kept separate from the frame stamp so a run of
+// silent blocks can share one cached zero analysis.
+struct ClamourAnalysis {
+    std::vector<float> spectrum;        // smoothed FFT magnitudes
+    std::vector<float> linearAverages;
+    std::vector<float> bands;           // log averages, scaled by the band sliders
+    SpectralFeatures features;
+};
+
+typedef std::shared_ptr<const ClamourAnalysis> ClamourAnalysisPtr;
+
+// One analysis result, published to every sink. Frames are never modified
+// after they are published, so sinks can share them across threads.
+struct ClamourFrame {
+    uint64_t sequence = 0;              // one per audio block, a gap means a block was dropped
+    uint64_t samplePosition = 0;        // audio sample clock at the centre of the FFT window
+    uint64_t captureMicros = 0;         // ofGetElapsedTimeMicros() at the centre of the FFT window
+    int sampleRate = 0;
+    bool bSilent = false;               // input was below the idle gate, analysis is all zeros
+    float rms = 0;                      // RMS of the input block after gain, sent when FEATURE_RMS is enabled
+
+    ClamourAnalysisPtr analysis;
+};
+
+typedef std::shared_ptr<const ClamourFrame> ClamourFramePtr;
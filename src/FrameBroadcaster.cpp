@@ -0,0 +1,133 @@
+#include "FrameBroadcaster.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+//--------------------------------------------------------------
+FrameBroadcaster::Channel::Channel(std::shared_ptr<FrameSink> sink, FrameSinkSettings settings)
+    : sink(sink)
+    , settings(settings)
+    , queue(settings.queueSize)
+    , dropped(0)
+    , latencyMicros(0.0f)
+    , bPending(false)
+{
+}
+
+//--------------------------------------------------------------
+FrameBroadcaster::FrameBroadcaster()
+    : bRunning(true)
+{
+}
+
+//--------------------------------------------------------------
+FrameBroadcaster::~FrameBroadcaster()
+{
+    stop();
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::addSink(std::shared_ptr<FrameSink> sink, FrameSinkSettings settings)
+{
+    channels.push_back(std::unique_ptr<Channel>(new Channel(sink, settings)));
+    Channel& channel = *channels.back();
+    if(settings.bThreaded) {
+        channel.thread = std::thread(&FrameBroadcaster::run, this, std::ref(channel));
+    }
+    ofLogNotice() << "Added output sink: " << sink->getName();
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::publish(const ClamourFramePtr& frame)
+{
+    for(auto& channel : channels) {
+        if(!channel->sink->isEnabled()) continue;
+
+        if(channel->settings.dropPolicy == FrameDropPolicy::DropLatest) {
+            if(!channel->queue.push(frame)) channel->dropped++;
+        } else {
+            while(!channel->queue.push(frame)) {
+                ClamourFramePtr oldest;
+                if(channel->queue.pop(oldest)) channel->dropped++;
+            }
+        }
+
+        // The sink thread only holds wakeMutex while checking bPending, never while processing
+        if(channel->settings.bThreaded) {
+            {
+                std::lock_guard<std::mutex> lock(channel->wakeMutex);
+                channel->bPending = true;
+            }
+            channel->wake.notify_one();
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::drain()
+{
+    for(auto& channel : channels) {
+        if(!channel->settings.bThreaded) processQueued(*channel);
+    }
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::stop()
+{
+    for(auto& channel : channels) {
+        {
+            std::lock_guard<std::mutex> lock(channel->wakeMutex);
+            bRunning = false;
+        }
+        channel->wake.notify_one();
+        if(channel->thread.joinable()) channel->thread.join();
+    }
+}
+
+//--------------------------------------------------------------
+uint64_t FrameBroadcaster::getDroppedFrames(const std::shared_ptr<FrameSink>& sink) const
+{
+    const Channel* channel = findChannel(sink);
+    return channel ? channel->dropped.load() : 0;
+}
+
+//--------------------------------------------------------------
+float FrameBroadcaster::getLatencyMicros(const std::shared_ptr<FrameSink>& sink) const
+{
+    const Channel* channel = findChannel(sink);
+    return channel ? channel->latencyMicros.load() : 0.0f;
+}
+
+//--------------------------------------------------------------
+const FrameBroadcaster::Channel* FrameBroadcaster::findChannel(const std::shared_ptr<FrameSink>& sink) const
+{
+    for(auto& channel : channels) {
+        if(channel->sink == sink) return channel.get();
+    }
+    return nullptr;
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::run(Channel& channel)
+{
+    while(true) {
+        std::unique_lock<std::mutex> lock(channel.wakeMutex);
+        channel.wake.wait(lock, [&]{ return !bRunning || channel.bPending; });
+        if(!bRunning) return;
+        channel.bPending = false;
+        lock.unlock();
+
+        processQueued(channel);
+    }
+}
+
+//--------------------------------------------------------------
+void FrameBroadcaster::processQueued(Channel& channel)
+{
+    ClamourFramePtr frame;
+    while(channel.queue.pop(frame)) {
+        channel.sink->process(frame);
+
+        float latency = (float)(ofGetElapsedTimeMicros() - frame->captureMicros);
+        channel.latencyMicros = 0.9f*channel.latencyMicros + 0.1f*latency;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ClamourFrame.h"
+#include "FrameQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// An output stage. process() is called with each published frame, on the
+// sink's own thread (or on the thread calling FrameBroadcaster::drain() for
+// sinks that must run on the render thread).
+class FrameSink {
+
+    public:
+
+        FrameSink() : bEnabled(true) {}
+        virtual ~FrameSink() {}
+
+        virtual std::string getName() const = 0;
+        // Sinks may keep the frame pointer, frames are never modified after publishing
+        virtual void process(const ClamourFramePtr& frame) = 0;
+
+        // Disabled sinks are skipped at publish time and never see a frame
+        void setEnabled(bool enabled) { bEnabled = enabled; }
+        bool isEnabled() const { return bEnabled; }
+
+    private:
+
+        std::atomic<bool> bEnabled;
+};
+
+// What to do when a sink's queue is full
+enum class FrameDropPolicy {
+    DropOldest,     // discard the oldest queued frame to make room
+    DropLatest      // discard the frame being published
+};
+
+struct FrameSinkSettings {
+    size_t queueSize = 4;
+    FrameDropPolicy dropPolicy = FrameDropPolicy::DropOldest;
+    bool bThreaded = true;      // false: processed by drain() on the caller's thread
+};
+
+// Publishes immutable frames to every registered sink. publish() never
+// blocks: each sink has its own bounded queue, and a slow sink only loses
+// its own frames.
+class FrameBroadcaster {
+
+    public:
+
+        FrameBroadcaster();
+        ~FrameBroadcaster();
+
+        // Register all sinks before the first publish()
+        void addSink(std::shared_ptr<FrameSink> sink, FrameSinkSettings settings = FrameSinkSettings());
+        void publish(const ClamourFramePtr& frame);
+        void drain();
+        void stop();
+
+        uint64_t getDroppedFrames(const std::shared_ptr<FrameSink>& sink) const;
+        // Smoothed time from capture to the end of the sink's process()
+        float getLatencyMicros(const std::shared_ptr<FrameSink>& sink) const;
+
+    private:
+
+        struct Channel {
+            Channel(std::shared_ptr<FrameSink> sink, FrameSinkSettings settings);
+
+            std::shared_ptr<FrameSink> sink;
+            FrameSinkSettings settings;
+            FrameQueue<ClamourFramePtr> queue;
+            std::atomic<uint64_t> dropped;
+            std::atomic<float> latencyMicros;
+            std::mutex wakeMutex;
+            std::condition_variable wake;
+            bool bPending;                  // guarded by wakeMutex
+            std::thread thread;
+        };
+
+        const Channel* findChannel(const std::shared_ptr<FrameSink>& sink) const;
+        void run(Channel& channel);
+        void processQueued(Channel& channel);
+
+        std::vector<std::unique_ptr<Channel>> channels;
+        std::atomic<bool> bRunning;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue (Dmitry Vyukov's MPMC ring). Any thread may push or
+// pop, which lets the publisher pop the oldest entry itself when a sink falls
+// behind. Capacity is rounded up to a power of two.
+template<typename T>
+class FrameQueue {
+
+    public:
+
+        explicit FrameQueue(size_t requestedCapacity)
+        {
+            size_t capacity = 2;
+            while(capacity < requestedCapacity) capacity *= 2;
+            cells.reset(new Cell[capacity]);
+            mask = capacity - 1;
+            for(size_t i = 0; i < capacity; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            enqueuePos.store(0, std::memory_order_relaxed);
+            dequeuePos.store(0, std::memory_order_relaxed);
+        }
+
+        bool push(const T& value)
+        {
+            Cell* cell;
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            for(;;) {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+                if(dif == 0) {
+                    if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if(dif < 0) {
+                    return false; // full
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = value;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& value)
+        {
+            Cell* cell;
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            for(;;) {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+                if(dif == 0) {
+                    if(dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if(dif < 0) {
+                    return false; // empty
+                } else {
+                    pos = dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->data);
+            cell->data = T(); // don't keep the payload alive in the ring
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return enqueuePos.load(std::memory_order_acquire) == dequeuePos.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        std::atomic<size_t> enqueuePos;
+        std::atomic<size_t> dequeuePos;
+};
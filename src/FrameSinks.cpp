@@ -0,0 +1,156 @@
+#include "FrameSinks.h"
+#include <chrono>
+
+//--------------------------------------------------------------
+// Converts a capture time on the ofGetElapsedTimeMicros() clock to an NTP timetag
+static uint64_t toOscTimetag(uint64_t captureMicros)
+{
+    using namespace std::chrono;
+    uint64_t age = ofGetElapsedTimeMicros() - captureMicros;
+    uint64_t unixMicros = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() - age;
+    uint64_t seconds = unixMicros / 1000000 + 2208988800ULL; // NTP epoch is 1900
+    uint64_t fraction = ((unixMicros % 1000000) << 32) / 1000000;
+    return (seconds << 32) | fraction;
+}
+
+//--------------------------------------------------------------
+void OscSink::setup(const string& host, int port)
+{
+    ofxOscSenderSettings oscSettings;
+    oscSettings.host = host;
+    oscSettings.port = port;
+    osc.setup(oscSettings);
+}
+
+//--------------------------------------------------------------
+void OscSink::process(const ClamourFramePtr& framePtr)
+{
+    const ClamourFrame& frame = *framePtr;
+    const ClamourAnalysis& analysis = *frame.analysis;
+
+    // One bundle per frame, so the stamp can't be separated from its bands over UDP
+    ofxOscBundle bundle;
+
+    ofxOscMessage header;
+    header.setAddress("/fft/frame");
+    header.addInt64Arg(frame.sequence);
+    header.addInt64Arg(frame.samplePosition);
+    header.addIntArg(frame.sampleRate);
+    header.addTimetagArg(toOscTimetag(frame.captureMicros));
+    header.addFloatArg((ofGetElapsedTimeMicros() - frame.captureMicros) / 1000.0f);
+    header.addIntArg(frame.bSilent ? 1 : 0);
+    bundle.addMessage(header);
+
+    // During a silent run the zero bands have already been sent once
+    bool bRepeat = frame.bSilent && frame.analysis == lastAnalysis;
+    lastAnalysis = frame.analysis;
+
+    if(!bRepeat) {
+        for(int i = 0; i < (int)analysis.bands.size() - 1; i++) // last band is NaN for some reason
+        {
+            addFloat(bundle, "/fft/band"+ofToString(i), analysis.bands[i]);
+        }
+
+        const SpectralFeatures& features = analysis.features;
+        if(features.enabled & FEATURE_CENTROID) addFloat(bundle, "/fft/centroid", features.centroid);
+        if(features.enabled & FEATURE_ROLLOFF) addFloat(bundle, "/fft/rolloff", features.rolloff);
+        if(features.enabled & FEATURE_FLATNESS) addFloat(bundle, "/fft/flatness", features.flatness);
+        if(features.enabled & FEATURE_FLUX) addFloat(bundle, "/fft/flux", features.flux);
+        if(features.enabled & FEATURE_ENERGY) addFloat(bundle, "/fft/energy", features.energy);
+    }
+    // The signal level changes block to block even while the cached zero analysis repeats
+    if(analysis.features.enabled & FEATURE_RMS) addFloat(bundle, "/fft/rms", frame.rms);
+
+    osc.sendBundle(bundle);
+}
+
+//--------------------------------------------------------------
+void OscSink::addFloat(ofxOscBundle& bundle, const string& address, float value)
+{
+    ofxOscMessage m;
+    m.setAddress(address);
+    m.addFloatArg(value);
+    bundle.addMessage(m);
+}
+
+//--------------------------------------------------------------
+SerialSink::SerialSink()
+    : bIsSetup(false)
+    , bVerifyData(false)
+{
+}
+
+//--------------------------------------------------------------
+bool SerialSink::setup(const string& portName, int baudRate)
+{
+    bIsSetup = serial.setup(portName, baudRate);
+    if(bIsSetup) {
+        ofLogNotice() << "Set up serial port successfully...";
+    }
+    return bIsSetup;
+}
+
+//--------------------------------------------------------------
+void SerialSink::process(const ClamourFramePtr& framePtr)
+{
+    const ClamourFrame& frame = *framePtr;
+    const vector<float>& bands = frame.analysis->bands;
+    //To verify data, set bVerifyData=true and send data back via Arduino. Note this is for debugging purposes only
+    if(bVerifyData) {
+        unsigned char bytesReturned[30];
+        int nRead  = 0;
+        nRead = serial.readBytes( bytesReturned, 30);
+        if(nRead == OF_SERIAL_NO_DATA) {
+            ofLogNotice() << ".... OF_SERIAL_NO_DATA";
+        } else {
+            cout << "Read: " << nRead << " bytes: " << std::flush;
+            for(int i = 0; i < nRead;i++)
+            {
+                 cout << " " << (int) bytesReturned[i] << std::flush;
+            }
+            cout << endl;
+        }
+        ofLogNotice() << "----------------------------------------------------------------------------------------------";
+    }
+
+    uint64_t latencyMs = min<uint64_t>((ofGetElapsedTimeMicros() - frame.captureMicros) / 1000, 0x3FFF);
+
+    // Same 29 bands as OSC, the last band is NaN for some reason
+    int numBands = max((int)bands.size() - 1, 0);
+    buf.resize(headerSize + numBands);
+    buf[0] = 0xFF;
+    buf[1] = frame.sequence & 0x7F;
+    for(int i = 0; i < 4; i++)
+    {
+        buf[2+i] = (frame.samplePosition >> (7*i)) & 0x7F;
+    }
+    buf[6] = latencyMs & 0x7F;
+    buf[7] = (latencyMs >> 7) & 0x7F;
+
+    for(int i = 0; i < numBands; i++)
+    {
+        buf[headerSize+i] = (unsigned char)(ofClamp(bands[i],0.0f,1.0f)*254);
+    }
+
+    long val = serial.writeBytes(buf.data(),buf.size());
+    if(val == OF_SERIAL_ERROR) {
+        ofLogError() << "Error writing FFT data...";
+    } else {
+        ofLogVerbose() << "Wrote " << val << " bytes.";
+    }
+
+    if(bVerifyData) {
+        cout << "Sent: " << buf.size() << " bytes: " << std::flush;
+        for(unsigned int i = 0; i < buf.size(); i++)
+        {
+            cout << " " << (int)buf[i] << std::flush;
+        }
+        cout << endl;
+    }
+}
+
+//--------------------------------------------------------------
+void GuiSink::process(const ClamourFramePtr& frame)
+{
+    latest = frame;
+}
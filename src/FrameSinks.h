@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "FrameBroadcaster.h"
+
+// Sends one bundle per frame: /fft/frame (sequence, sample position, sample rate, capture timetag, latency ms, silent)
+// followed by each band as /fft/band<n> and each enabled spectral feature
+// as /fft/centroid, /fft/rolloff, /fft/flatness, /fft/flux and /fft/energy, plus the signal /fft/rms.
+// While the input is gated only /fft/frame and /fft/rms are sent after the first zero frame.
+class OscSink : public FrameSink {
+
+    public:
+
+        void setup(const string& host, int port);
+
+        string getName() const { return "OSC"; }
+        void process(const ClamourFramePtr& frame);
+
+    private:
+
+        void addFloat(ofxOscBundle& bundle, const string& address, float value);
+
+        ofxOscSender osc;
+        ClamourAnalysisPtr lastAnalysis;
+};
+
+// Sends each frame to an Arduino, see arduino/SerialClamour. Layout:
+//   0xFF sync, sequence, sample position (4 bytes), latency ms (2 bytes), one byte (0-254) for each of 29 bands
+// Header fields are packed 7 bits per byte, LSB first, so 0xFF only ever marks the start of a frame.
+// Sequence is sent modulo 2^7 and sample position modulo 2^28 (~101 minutes at 44.1kHz).
+class SerialSink : public FrameSink {
+
+    public:
+
+        SerialSink();
+        bool setup(const string& portName, int baudRate);
+        bool isSetup() const { return bIsSetup; }
+
+        string getName() const { return "Serial"; }
+        void process(const ClamourFramePtr& frame);
+
+    private:
+
+        static const int headerSize = 8;
+
+        ofSerial serial;
+        bool bIsSetup;
+        vector<unsigned char> buf;
+        bool bVerifyData;
+};
+
+// Keeps the latest frame for draw(). Register it unthreaded and drain() it from update().
+class GuiSink : public FrameSink {
+
+    public:
+
+        string getName() const { return "GUI"; }
+        void process(const ClamourFramePtr& frame);
+        const ClamourFramePtr& getFrame() const { return latest; }
+
+    private:
+
+        ClamourFramePtr latest;
+};
@@ -0,0 +1,176 @@
+#include "SpectralFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------
+SpectralFeatureExtractor::SpectralFeatureExtractor()
+    : binSize(0)
+    , binWidth(0)
+    , rolloffFraction(0.85f)
+    , requested(0)
+    , bHavePrevious(false)
+{
+}
+
+//--------------------------------------------------------------
+void SpectralFeatureExtractor::setup(int binSize, float binWidth, float rolloffFraction)
+{
+    this->binSize = binSize;
+    this->binWidth = binWidth;
+    this->rolloffFraction = rolloffFraction;
+    previous.assign(binSize, 0.0f);
+    cumulativeEnergy.assign((binSize + lanes - 1) / lanes, 0.0f);
+    bHavePrevious = false;
+}
+
+//--------------------------------------------------------------
+void SpectralFeatureExtractor::setEnabled(unsigned int enabled)
+{
+    enabled &= FEATURE_ALL;
+    // Flux is meaningless against a spectrum from before it was switched on
+    if((enabled & FEATURE_FLUX) && !(requested & FEATURE_FLUX)) bHavePrevious = false;
+    requested = enabled;
+    features = SpectralFeatures();
+    features.enabled = enabled;
+}
+
+//--------------------------------------------------------------
+const SpectralFeatures& SpectralFeatureExtractor::process(const std::vector<float>& spectrum)
+{
+    static const auto kernels = makeKernels(std::make_index_sequence<FEATURE_SPECTRAL + 1>());
+
+    if((features.enabled & FEATURE_SPECTRAL) == 0) return features;
+    if((int)spectrum.size() < binSize || binSize == 0) {
+        // Nothing was computed, so don't let sinks send the zeroed fields as valid
+        features.enabled &= ~FEATURE_SPECTRAL;
+        return features;
+    }
+    (this->*kernels[features.enabled & FEATURE_SPECTRAL])(spectrum.data());
+    return features;
+}
+
+//--------------------------------------------------------------
+// Each reduction keeps one partial sum per lane, combined after the loop. Independent
+// lanes let the compiler vectorise the float sums without fast-math reassociation.
+// Rolloff records one energy total per chunk of lanes; only those totals are
+// accumulated afterwards, and only the chunk holding the rolloff point is walked
+// bin by bin. The logs for flatness get their own pass: logf() is a scalar libm call, and
+// inside the main loop it would stop the other reductions from being vectorised.
+template<unsigned int Features>
+void SpectralFeatureExtractor::extract(const float* spectrum)
+{
+    const bool bCentroid = Features & FEATURE_CENTROID;
+    const bool bRolloff  = Features & FEATURE_ROLLOFF;
+    const bool bFlatness = Features & FEATURE_FLATNESS;
+    const bool bFlux     = Features & FEATURE_FLUX;
+    const bool bEnergy   = Features & (FEATURE_FLATNESS | FEATURE_ENERGY);
+
+    float* __restrict prev = previous.data();
+    float* __restrict chunkEnergy = cumulativeEnergy.data();
+    float accMag[lanes] = {}, accWeighted[lanes] = {}, accEnergy[lanes] = {}, accFlux[lanes] = {};
+
+    const int fullChunks = binSize / lanes;
+    for(int c = 0; c < fullChunks; c++)
+    {
+        const int base = c*lanes;
+        float energy[lanes];
+        for(int l = 0; l < lanes; l++)
+        {
+            float mag = spectrum[base+l];
+            energy[l] = mag*mag;
+            if(bCentroid) {
+                accMag[l] += mag;
+                accWeighted[l] += (float)(base+l)*mag;
+            }
+            if(bEnergy) accEnergy[l] += energy[l];
+            if(bFlux) {
+                // Computed even without a previous spectrum and discarded below, to keep the loop branch free.
+                // (d + |d|)/2 is max(d, 0) in a form the compiler turns into vector code.
+                float delta = mag - prev[base+l];
+                float rise = 0.5f*(delta + fabsf(delta));
+                accFlux[l] += rise*rise;
+                prev[base+l] = mag;
+            }
+        }
+        if(bRolloff) {
+            chunkEnergy[c] = ((energy[0] + energy[1]) + (energy[2] + energy[3]))
+                           + ((energy[4] + energy[5]) + (energy[6] + energy[7]));
+        }
+    }
+
+    // Leftover bins (1025 = 128*8 + 1 for a 2048 FFT) go into lane 0 and one last partial chunk
+    float tailEnergy = 0;
+    for(int i = fullChunks*lanes; i < binSize; i++)
+    {
+        float mag = spectrum[i];
+        float energy = mag*mag;
+        if(bCentroid) {
+            accMag[0] += mag;
+            accWeighted[0] += (float)i*mag;
+        }
+        if(bEnergy) accEnergy[0] += energy;
+        if(bFlux) {
+            float rise = std::max(mag - prev[i], 0.0f);
+            accFlux[0] += rise*rise;
+            prev[i] = mag;
+        }
+        tailEnergy += energy;
+    }
+    const int numChunks = (binSize + lanes - 1) / lanes;
+    if(bRolloff && numChunks > fullChunks) chunkEnergy[fullChunks] = tailEnergy;
+
+    float sumMag = 0, sumWeighted = 0, sumEnergy = 0, sumFlux = 0;
+    for(int l = 0; l < lanes; l++)
+    {
+        sumMag += accMag[l];
+        sumWeighted += accWeighted[l];
+        sumEnergy += accEnergy[l];
+        sumFlux += accFlux[l];
+    }
+
+    if(bCentroid) {
+        features.centroid = sumMag > 0 ? binWidth * sumWeighted / sumMag : 0;
+    }
+    if(bRolloff) {
+        // Turn the chunk totals into running totals, 1/lanes of the spectrum
+        float running = 0;
+        for(int c = 0; c < numChunks; c++)
+        {
+            running += chunkEnergy[c];
+            chunkEnergy[c] = running;
+        }
+
+        float threshold = rolloffFraction * running;
+        int c = std::min((int)(std::lower_bound(chunkEnergy, chunkEnergy + numChunks, threshold) - chunkEnergy), numChunks - 1);
+        float cumulative = c > 0 ? chunkEnergy[c-1] : 0;
+        int end = std::min((c+1)*lanes, binSize);
+        int bin = end - 1;
+        for(int i = c*lanes; i < end; i++)
+        {
+            cumulative += spectrum[i]*spectrum[i];
+            if(cumulative >= threshold) {
+                bin = i;
+                break;
+            }
+        }
+        features.rolloff = binWidth * bin;
+    }
+    if(bFlatness) {
+        float sumLog = 0;
+        for(int i = 0; i < binSize; i++) sumLog += logf(spectrum[i]*spectrum[i] + 1e-12f);
+        float meanEnergy = sumEnergy / binSize;
+        features.flatness = meanEnergy > 0 ? expf(sumLog / binSize) / meanEnergy : 0;
+    }
+    if(bFlux) {
+        if(bHavePrevious) {
+            features.flux = sqrtf(sumFlux);
+        } else {
+            // No previous spectrum yet, so there is no flux to report for this frame
+            features.enabled &= ~FEATURE_FLUX;
+        }
+        bHavePrevious = true;
+    }
+    if(Features & FEATURE_ENERGY) {
+        features.energy = sumEnergy / binSize;
+    }
+}
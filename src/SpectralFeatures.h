@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+enum SpectralFeature {
+    FEATURE_CENTROID    = 1 << 0,
+    FEATURE_ROLLOFF     = 1 << 1,
+    FEATURE_FLATNESS    = 1 << 2,
+    FEATURE_FLUX        = 1 << 3,
+    FEATURE_ENERGY      = 1 << 4,
+    FEATURE_RMS         = 1 << 5,       // time domain, carried on ClamourFrame rather than computed here
+    FEATURE_SPECTRAL    = (1 << 5) - 1,     // computed from the spectrum by the extractor kernels
+    FEATURE_ALL         = (1 << 6) - 1
+};
+
+// Descriptors of one spectrum. Only the fields flagged in enabled are valid.
+struct SpectralFeatures {
+    unsigned int enabled = 0;
+    float centroid = 0;     // Hz
+    float rolloff = 0;      // Hz below which rolloffFraction of the energy lies
+    float flatness = 0;     // 0 (tonal) to 1 (noise)
+    float flux = 0;         // rectified change in magnitude since the previous spectrum
+    float energy = 0;       // mean |X|^2 over the smoothed spectrum. Relative only: not loudness, scales with FFT size
+};
+
+// Computes all enabled descriptors in a single pass over a magnitude spectrum.
+// Each combination of features has its own compiled kernel, so disabled
+// features add no work to the loop. Buffers are allocated in setup() only.
+class SpectralFeatureExtractor {
+
+    public:
+
+        SpectralFeatureExtractor();
+
+        void setup(int binSize, float binWidth, float rolloffFraction = 0.85f);
+        void setEnabled(unsigned int features);
+        const SpectralFeatures& process(const std::vector<float>& spectrum);
+        const SpectralFeatures& getFeatures() const { return features; }
+
+    private:
+
+        static const int lanes = 8;
+
+        typedef void (SpectralFeatureExtractor::*Kernel)(const float* spectrum);
+
+        template<unsigned int Features> void extract(const float* spectrum);
+
+        template<size_t... I>
+        static std::array<Kernel, sizeof...(I)> makeKernels(std::index_sequence<I...>)
+        {
+            return {{ &SpectralFeatureExtractor::extract<I>... }};
+        }
+
+        SpectralFeatures features;
+        int binSize;
+        float binWidth;
+        float rolloffFraction;
+        unsigned int requested;                 // last mask passed to setEnabled()
+        bool bHavePrevious;
+        std::vector<float> previous;            // last spectrum, for flux
+        std::vector<float> cumulativeEnergy;    // energy per chunk of lanes, then running totals, for rolloff
+};
@@ -1,4 +1,7 @@
 #include "ofApp.h"
+#ifndef TARGET_OPENGLES
+#include "ofAppGLFWWindow.h"
+#endif
 
 //--------------------------------------------------------------
 void ofApp::setup(){
@@ -6,7 +9,8 @@ void ofApp::setup(){
     background.set(ofColor(0,52,52));
     ofBackground(background);
     ofSetWindowTitle("Clamour");
-    ofSetFrameRate(60);
+    setupIdleMode();
+    ofSetFrameRate(fullFrameRate);
 
     setupFFT();
     setupLinearAverages(numLinearAverages);
@@ -14,17 +18,30 @@ void ofApp::setup(){
     setupGui();
     setupAudio();    
     setupXmlSettings();
-    setupSerial();
+    setupOutputs();
 
-    ofxOscSenderSettings oscSettings;
-    oscSettings.host = "localhost";
-    oscSettings.port = 12345;
-    osc.setup(oscSettings);
+    bAnalysisRunning = true;
+    analysisThread = std::thread(&ofApp::analysisLoop, this);
 }
 
 //--------------------------------------------------------------
 void ofApp::exit()
 {
+    soundStream.close();
+    soundMutex.lock();
+    bAnalysisRunning = false;
+    soundMutex.unlock();
+    analysisWake.notify_one();
+    if(analysisThread.joinable()) analysisThread.join();
+
+    broadcaster.stop();
+    ofLogNotice() << "Dropped audio blocks: " << droppedBlocks;
+    ofLogNotice() << "Dropped frames: OSC " << broadcaster.getDroppedFrames(oscSink)
+                  << ", serial " << broadcaster.getDroppedFrames(serialSink);
+    ofLogNotice() << "Capture to output latency: OSC " << broadcaster.getLatencyMicros(oscSink) / 1000.0f
+                  << " ms, serial " << broadcaster.getLatencyMicros(serialSink) / 1000.0f << " ms";
+    ofLogNotice() << "Idle mode saved approx. " << (int)(totalSavedMicros / 1000000.0) << " s of CPU time ("
+                  << gatedBlocks << " of " << (gatedBlocks + analysedBlocks) << " audio blocks gated)";
     ofLogNotice() << "Saving parameters...";
     gui.saveToFile("parameter-settings.xml");
 }
@@ -54,6 +71,19 @@ void ofApp::setupGui()
     gui.add(bSendOSC);
     bSendSerial.set("Send to Serial",false);
     gui.add(bSendSerial);
+    bIdleMode.set("Idle mode",true);
+    gui.add(bIdleMode);
+    gateThreshold.set("Gate threshold dB",-60.0f,-100.0f,0.0f);
+    gui.add(gateThreshold);
+
+    featureParams.setName("Spectral features");
+    featureParams.add(bCentroid.set("Centroid",false));
+    featureParams.add(bRolloff.set("Rolloff",false));
+    featureParams.add(bFlatness.set("Flatness",false));
+    featureParams.add(bFlux.set("Flux",false));
+    featureParams.add(bEnergy.set("Energy",false));
+    featureParams.add(bRms.set("RMS",false));
+    gui.add(featureParams);
     gui.setPosition(ofGetWidth()-220,5);
     gui.loadFromFile("parameter-settings.xml");
     plotType = 1;
@@ -61,21 +91,64 @@ void ofApp::setupGui()
 
 //--------------------------------------------------------------
 void ofApp::setupFFT() {
-    bIsSerialSetup = false;
     bufferSize = 2048;
     sampleRate = 44100;
 
     fft = ofxFft::create(bufferSize, OF_FFT_WINDOW_HAMMING, OF_FFT_FFTW);
 
-    drawBins.resize(fft->getBinSize());
+    analysisBins.resize(fft->getBinSize());
     middleBins.resize(fft->getBinSize());
     audioBins.resize(fft->getBinSize());
     plotHeight = 350;
 
+    samplesCaptured = 0;
+    blockRing.resize(8);
+    for(auto& block : blockRing) {
+        block.bins.resize(fft->getBinSize());
+    }
+    blockRingWrite = blockRingRead = 0;
+    blockSequence = 0;
+    droppedBlocks = 0;
+    analysisSequence = analysisSamplePosition = analysisCaptureMicros = 0;
+    analysisRms = 0;
+    zeroFeatures = 0;
+
     bandWidth = (2.0f / bufferSize) * ((float)sampleRate / 2.0f);
+    featureExtractor.setup(fft->getBinSize(), bandWidth);
     numLinearAverages = 8;
 }
 
+//--------------------------------------------------------------
+void ofApp::setupIdleMode()
+{
+    fullFrameRate = 60;
+    idleFrameRate = 4;
+    gateHoldLength = 10; // ~0.5 s at 2048 samples / 44.1kHz
+    gateHoldBlocks = 0;
+    bGateOpen = true;
+    bIdle = false;
+    bWakeRender = false;
+    lastInteractionMicros = 0;
+
+    staticFrames = 0;
+    bSpectrumStatic = false;
+    bSpectrumActive = true;
+    idleSkippedFrames = 0.0f;
+
+    analysedBlocks = 0;
+    gatedBlocks = 0;
+    fftMicros = 0.0f;
+    analysisMicros = 0.0f;
+    frameMicros = 0.0f;
+    frameStartMicros = 0;
+    statsLastMicros = 0;
+    statsLastGated = 0;
+    statsLastAnalysed = 0;
+    gatedPercent = 0.0f;
+    cpuSavedPercent = 0.0f;
+    totalSavedMicros = 0.0;
+}
+
 //--------------------------------------------------------------
 void ofApp::setupSerial()
 {
@@ -87,14 +160,34 @@ void ofApp::setupSerial()
     // (ie, COM4 on a pc, /dev/tty.... on linux, /dev/tty... on a mac)
     // arduino users check in arduino app....
     int baud = baudRate;
-    bool bSuccess = serial.setup(serialPortName, baud); //open the first device
-    //serial.setup("COM4", baud); // windows example
-    //serial.setup("/dev/tty.usbserial-A4001JEC", baud); // mac osx example
-    //serial.setup("/dev/ttyUSB0", baud); //linux example
-    if(bSuccess) {
-        bIsSerialSetup = true;
-        ofLogNotice() << "Set up serial port successfully...";
-    }
+    serialSink->setup(serialPortName, baud); //open the first device
+    //serialSink->setup("COM4", baud); // windows example
+    //serialSink->setup("/dev/tty.usbserial-A4001JEC", baud); // mac osx example
+    //serialSink->setup("/dev/ttyUSB0", baud); //linux example
+}
+
+//--------------------------------------------------------------
+void ofApp::setupOutputs()
+{
+    guiSink = make_shared<GuiSink>();
+    FrameSinkSettings guiSettings;
+    guiSettings.queueSize = 2;
+    guiSettings.bThreaded = false;
+    broadcaster.addSink(guiSink, guiSettings);
+
+    oscSink = make_shared<OscSink>();
+    oscSink->setup("localhost", 12345);
+    oscSink->setEnabled(false);
+    broadcaster.addSink(oscSink);
+
+    serialSink = make_shared<SerialSink>();
+    serialSink->setEnabled(false);
+    setupSerial();
+    // A slow serial link should skip to the newest bands rather than fall behind
+    FrameSinkSettings serialSettings;
+    serialSettings.queueSize = 2;
+    serialSettings.dropPolicy = FrameDropPolicy::DropOldest;
+    broadcaster.addSink(serialSink, serialSettings);
 }
 
 //--------------------------------------------------------------
@@ -129,33 +222,117 @@ void ofApp::setupAudio()
 
 //--------------------------------------------------------------
 void ofApp::update(){
-    soundMutex.lock();
-	drawBins = middleBins;
-	soundMutex.unlock();
+    updateIdleState();
+    frameStartMicros = ofGetElapsedTimeMicros();
+    updateIdleStats();
 
-    doLinearAverage(drawBins);
-    doLogAverage(drawBins);
+    oscSink->setEnabled(bSendOSC);
+    serialSink->setEnabled(serialSink->isSetup() && bSendSerial && (ofGetFrameNum() > 60));
 
-    for(int i = 0; i < log_averages.size(); i++)
-    {
-        log_averages[i] = log_averages[i]*sliders[i].get();
+    // Sinks that need the GL thread run here; the others have their own threads
+    broadcaster.drain();
+}
+
+//--------------------------------------------------------------
+void ofApp::analysisLoop()
+{
+    // Analysis and publishing run once per audio block here, independent of the render rate
+    while(true) {
+        std::unique_lock<std::mutex> lock(soundMutex);
+        analysisWake.wait(lock, [this]{ return !bAnalysisRunning || blockRingRead != blockRingWrite; });
+        if(!bAnalysisRunning) return;
+        AnalysisBlock& block = blockRing[blockRingRead % blockRing.size()];
+        bool bSilent = block.bSilent;
+        if(!bSilent) analysisBins = block.bins;
+        analysisSequence = block.sequence;
+        analysisSamplePosition = block.samplePosition;
+        analysisCaptureMicros = block.captureMicros;
+        analysisRms = block.rms;
+        blockRingRead++;
+        lock.unlock();
+
+        analyseBlock(bSilent);
     }
+}
 
-    //Send to Arduino
-    if(bIsSerialSetup && bSendSerial && (ofGetFrameNum() > 60)) {
-        sendSerialData();
+//--------------------------------------------------------------
+void ofApp::analyseBlock(bool bSilent)
+{
+    if(bSilent) {
+        // Silence is analysed once, after that the cached zero analysis is re-stamped
+        bSpectrumActive = false;
+        unsigned int features = getEnabledFeatures();
+        if(!zeroAnalysis || zeroFeatures != features || zeroAnalysis->linearAverages.size() != (size_t)numLinearAverages) {
+            std::fill(analysisBins.begin(), analysisBins.end(), 0.0f);
+            zeroAnalysis = analyseSpectrum();
+            zeroFeatures = features;
+        }
+        publishFrame(zeroAnalysis, true);
+        return;
     }
+    zeroAnalysis.reset();
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    detectStaticSpectrum();
 
-    if(bSendOSC) {
-        for(int i = 0; i < log_averages.size() -1; i++) // last band is NaN for some reason
+    // Wake the render loop as soon as there is something new to show
+    bool bActive = bGateOpen && !bSpectrumStatic;
+    if(bActive && !bSpectrumActive.exchange(bActive)) {
         {
-            ofxOscMessage m;
-            m.setAddress("/fft/band"+ofToString(i));
-            m.addFloatArg(log_averages[i]);
-            osc.sendMessage(m, false);
+            std::lock_guard<std::mutex> lock(idleMutex);
+            bWakeRender = true;
         }
+        idleWake.notify_one();
+    }
+    bSpectrumActive = bActive;
+
+    publishFrame(analyseSpectrum(), false);
+    analysisMicros = 0.9f*analysisMicros + 0.1f*(float)(ofGetElapsedTimeMicros() - start);
+}
+
+//--------------------------------------------------------------
+ClamourAnalysisPtr ofApp::analyseSpectrum()
+{
+    if(averages.size() != (size_t)numLinearAverages) setupLinearAverages(numLinearAverages);
+    doLinearAverage(analysisBins);
+    doLogAverage(analysisBins);
+
+    for(int i = 0; i < log_averages.size(); i++)
+    {
+        log_averages[i] = log_averages[i]*sliders[i].get();
     }
 
+    featureExtractor.setEnabled(getEnabledFeatures());
+    featureExtractor.process(analysisBins);
+
+    auto analysis = make_shared<ClamourAnalysis>();
+    analysis->spectrum = analysisBins;
+    analysis->linearAverages = averages;
+    analysis->bands = log_averages;
+    analysis->features = featureExtractor.getFeatures();
+    return analysis;
+}
+
+//--------------------------------------------------------------
+unsigned int ofApp::getEnabledFeatures()
+{
+    return (bCentroid ? FEATURE_CENTROID : 0) | (bRolloff ? FEATURE_ROLLOFF : 0)
+         | (bFlatness ? FEATURE_FLATNESS : 0) | (bFlux ? FEATURE_FLUX : 0) | (bEnergy ? FEATURE_ENERGY : 0)
+         | (bRms ? FEATURE_RMS : 0);
+}
+
+//--------------------------------------------------------------
+void ofApp::publishFrame(const ClamourAnalysisPtr& analysis, bool bSilent)
+{
+    auto frame = make_shared<ClamourFrame>();
+    frame->sequence = analysisSequence;
+    frame->samplePosition = analysisSamplePosition;
+    frame->captureMicros = analysisCaptureMicros;
+    frame->sampleRate = sampleRate;
+    frame->bSilent = bSilent;
+    frame->rms = analysisRms;
+    frame->analysis = analysis;
+    broadcaster.publish(frame);
 }
 
 //--------------------------------------------------------------
@@ -165,40 +342,198 @@ void ofApp::draw(){
     int margin = 250;
     ratio = (float) (ofGetWidth()-margin) / (float) fft->getBinSize();
 
-    if(plotType == 1) {
-        plotFFT(drawBins, plotHeight, 5);
-    } else if (plotType ==2) {
-        plotLinearAverages(drawBins,plotHeight,5);
-    } else if (plotType == 3) {
-        plotLogAverages(drawBins,plotHeight,5);
+    ClamourFramePtr latest = guiSink->getFrame();
+    if(latest) {
+        const ClamourAnalysis& frame = *latest->analysis;
+        if(plotType == 1) {
+            plotFFT(frame, plotHeight, 5);
+        } else if (plotType ==2) {
+            plotLinearAverages(frame,plotHeight,5);
+        } else if (plotType == 3) {
+            plotLogAverages(frame,plotHeight,5);
+        }
+        plotLinLogAverages(frame,plotHeight,ofGetHeight() - plotHeight-40);
     }
-    plotLinLogAverages(drawBins,plotHeight,ofGetHeight() - plotHeight-40);
 
     ofDrawBitmapString("OSC address range: \n/fft/band0 to /fft/band28", ofGetWidth() - 220, ofGetHeight() - 45);
     ofDrawBitmapString(ofToString((int) ofGetFrameRate()) + " fps", ofGetWidth() - 60, ofGetHeight() - 15);
+    if(bIdleMode) {
+        ofDrawBitmapString(string(bIdle ? "Idle" : "Active") + ", gated " + ofToString((int)gatedPercent) + "%\n"
+                           + "CPU saved ~" + ofToString(cpuSavedPercent, 1) + "%", ofGetWidth() - 220, ofGetHeight() - 85);
+    }
+    if(oscSink->isEnabled() || serialSink->isEnabled()) {
+        string latency = "Latency";
+        if(oscSink->isEnabled()) latency += " OSC " + ofToString((int)(broadcaster.getLatencyMicros(oscSink) / 1000)) + "ms";
+        if(serialSink->isEnabled()) latency += " Ser " + ofToString((int)(broadcaster.getLatencyMicros(serialSink) / 1000)) + "ms";
+        ofDrawBitmapString(latency, ofGetWidth() - 220, ofGetHeight() - 115);
+    }
 
     gui.draw();
+
+    frameMicros = 0.9f*frameMicros + 0.1f*(float)(ofGetElapsedTimeMicros() - frameStartMicros);
+}
+
+//--------------------------------------------------------------
+void ofApp::updateIdleState()
+{
+    // Keep full rate while the user is interacting, so the GUI stays responsive
+    bool bInteracting = (ofGetElapsedTimeMicros() - lastInteractionMicros) < 2000000;
+
+    // Outputs are published from the analysis thread, so only drawing slows down here
+    bIdle = bIdleMode && !bInteracting && (!bSpectrumActive || isWindowHidden());
+    if(!bIdle) return;
+
+    // Sleep out the rest of an idle frame, but wake as soon as the analysis thread sees a changing spectrum
+    uint64_t waitStart = ofGetElapsedTimeMicros();
+    std::unique_lock<std::mutex> lock(idleMutex);
+    idleWake.wait_for(lock, std::chrono::milliseconds(1000 / idleFrameRate), [this]{ return bWakeRender; });
+    bWakeRender = false;
+
+    // Frames full rate would have drawn while we slept
+    idleSkippedFrames += (ofGetElapsedTimeMicros() - waitStart) * fullFrameRate / 1000000.0f;
+}
+
+//--------------------------------------------------------------
+void ofApp::detectStaticSpectrum()
+{
+    if(lastAnalysisBins.size() != analysisBins.size()) {
+        lastAnalysisBins = analysisBins;
+        return;
+    }
+
+    float maxDelta = 0;
+    for(unsigned int i = 0; i < analysisBins.size(); i++) {
+        maxDelta = max(maxDelta, fabsf(analysisBins[i] - lastAnalysisBins[i]));
+    }
+    lastAnalysisBins = analysisBins;
+
+    if(maxDelta < 0.0001f) staticFrames++;
+    else staticFrames = 0;
+    bSpectrumStatic = (staticFrames > 30);
+}
+
+//--------------------------------------------------------------
+void ofApp::updateIdleStats()
+{
+    uint64_t now = ofGetElapsedTimeMicros();
+    if(now - statsLastMicros < 1000000) return;
+
+    float seconds = (now - statsLastMicros) / 1000000.0f;
+    uint64_t gated = gatedBlocks;
+    uint64_t analysed = analysedBlocks;
+    uint64_t newGated = gated - statsLastGated;
+    uint64_t newAnalysed = analysed - statsLastAnalysed;
+    statsLastMicros = now;
+    statsLastGated = gated;
+    statsLastAnalysed = analysed;
+
+    if(newGated + newAnalysed > 0) {
+        gatedPercent = 100.0f * newGated / (float)(newGated + newAnalysed);
+    }
+
+    // Estimate savings as the FFT and analysis work skipped for gated blocks plus the frames we didn't render while idle
+    float savedMicros = newGated * (fftMicros.load() + analysisMicros.load()) + idleSkippedFrames * frameMicros;
+    idleSkippedFrames = 0.0f;
+    totalSavedMicros += savedMicros;
+    cpuSavedPercent = 100.0f * savedMicros / (seconds * 1000000.0f);
+}
+
+//--------------------------------------------------------------
+bool ofApp::isWindowHidden()
+{
+#ifndef TARGET_OPENGLES
+    ofAppGLFWWindow* window = dynamic_cast<ofAppGLFWWindow*>(ofGetWindowPtr());
+    if(window && window->getGLFWWindow()) {
+        GLFWwindow* glfwWindow = window->getGLFWWindow();
+        return glfwGetWindowAttrib(glfwWindow, GLFW_ICONIFIED) || !glfwGetWindowAttrib(glfwWindow, GLFW_FOCUSED);
+    }
+#endif
+    return false;
+}
+
+//--------------------------------------------------------------
+bool ofApp::isSilentBlock(float rms, float peak)
+{
+    float threshold = powf(10.0f, gateThreshold.get() / 20.0f);
+
+    // Peaks are let through at 12dB above the RMS threshold so short transients still open the gate
+    if(rms >= threshold || peak >= threshold * 4.0f) {
+        gateHoldBlocks = gateHoldLength;
+    } else if(gateHoldBlocks > 0) {
+        gateHoldBlocks--;
+    }
+    return gateHoldBlocks == 0;
 }
 
 //--------------------------------------------------------------
 void ofApp::audioReceived(float* input, int bufferSize, int nChannels)
 {
     // Set gain
+    float sumSquares = 0;
+    float peak = 0;
     for(int i = 0; i < bufferSize; i++) {
         input[i] *= gain.get();
+        sumSquares += input[i]*input[i];
+        peak = max(peak, fabsf(input[i]));
     }
 
+    // Stamp the block with the sample clock and time at the centre of the FFT window.
+    // The callback runs once the last sample is in, so the centre is half a buffer earlier.
+    uint64_t centreSample = samplesCaptured + bufferSize/2;
+    uint64_t halfBufferMicros = (uint64_t)bufferSize * 500000 / sampleRate;
+    uint64_t centreMicros = ofGetElapsedTimeMicros();
+    centreMicros = centreMicros > halfBufferMicros ? centreMicros - halfBufferMicros : 0;
+    samplesCaptured += bufferSize;
+
+    float rms = sqrtf(sumSquares / bufferSize);
+    bool bSilent = bIdleMode && isSilentBlock(rms, peak);
+    bool bWasOpen = bGateOpen.exchange(!bSilent);
+
+    if(bSilent) {
+        // Skip the FFT and publish a zero frame. Smoothing restarts from zero when the gate reopens.
+        gatedBlocks++;
+        if(bWasOpen) std::fill(middleBins.begin(), middleBins.end(), 0.0f);
+        queueBlock(centreSample, centreMicros, rms, true);
+        return;
+    }
+
+    uint64_t fftStart = ofGetElapsedTimeMicros();
     fft->setSignal(input);
 
     float* curFft = fft->getAmplitude();
     memcpy(&audioBins[0], curFft, sizeof(float) * fft->getBinSize());
+    fftMicros = 0.9f*fftMicros + 0.1f*(float)(ofGetElapsedTimeMicros() - fftStart);
+    analysedBlocks++;
 
-    soundMutex.lock();
     //middleBins = audioBins;
     for(int i = 0; i < fft->getBinSize(); i++) {
         middleBins[i] = 0.5f*middleBins[i] + 0.5f*audioBins[i];
     }
+    queueBlock(centreSample, centreMicros, rms, false);
+}
+
+//--------------------------------------------------------------
+void ofApp::queueBlock(uint64_t samplePosition, uint64_t captureMicros, float rms, bool bSilent)
+{
+    // Every block takes a sequence number, so a dropped block shows up as a gap downstream
+    uint64_t sequence = blockSequence++;
+
+    soundMutex.lock();
+    if(blockRingWrite - blockRingRead >= blockRing.size()) {
+        droppedBlocks++;
+        soundMutex.unlock();
+        return;
+    }
+    AnalysisBlock& block = blockRing[blockRingWrite % blockRing.size()];
+    if(!bSilent) block.bins = middleBins;
+    block.bSilent = bSilent;
+    block.sequence = sequence;
+    block.samplePosition = samplePosition;
+    block.captureMicros = captureMicros;
+    block.rms = rms;
+    blockRingWrite++;
     soundMutex.unlock();
+    analysisWake.notify_one();
 }
 
 //--------------------------------------------------------------
@@ -240,8 +575,9 @@ void ofApp::setupXmlSettings()
 }
 
 //--------------------------------------------------------------
-void ofApp::plotFFT(vector<float>& buffer, float height, float offset)
+void ofApp::plotFFT(const ClamourAnalysis& frame, float height, float offset)
 {
+    const vector<float>& buffer = frame.spectrum;
     ofPushStyle();
 	ofPushMatrix();
     ofTranslate(16, offset);
@@ -267,8 +603,9 @@ void ofApp::plotFFT(vector<float>& buffer, float height, float offset)
 }
 
 //--------------------------------------------------------------
-void ofApp::plotLinearAverages(vector<float>& buffer, float height, float offset)
+void ofApp::plotLinearAverages(const ClamourAnalysis& frame, float height, float offset)
 {
+    const vector<float>& buffer = frame.spectrum;
     ofPushStyle();
     ofPushMatrix();
 	ofTranslate(16, offset);
@@ -280,10 +617,10 @@ void ofApp::plotLinearAverages(vector<float>& buffer, float height, float offset
     ofNoFill();
     ofDrawRectangle(0, 0, buffer.size()*ratio, height);
 
-    int w = int( buffer.size()/averages.size());
-    for(unsigned int i = 0; i < averages.size(); i++)
+    int w = int( buffer.size()/frame.linearAverages.size());
+    for(unsigned int i = 0; i < frame.linearAverages.size(); i++)
     {
-        ofDrawRectangle(i*w*ratio, height - averages[i]*height, w*ratio, averages[i]*height);
+        ofDrawRectangle(i*w*ratio, height - frame.linearAverages[i]*height, w*ratio, frame.linearAverages[i]*height);
     }
 
     ofPopMatrix();
@@ -291,8 +628,9 @@ void ofApp::plotLinearAverages(vector<float>& buffer, float height, float offset
 }
 
 //--------------------------------------------------------------
-void ofApp::plotLogAverages(vector<float>& buffer, float height, float offset)
+void ofApp::plotLogAverages(const ClamourAnalysis& frame, float height, float offset)
 {
+    const vector<float>& buffer = frame.spectrum;
     ofPushStyle();
     ofPushMatrix();
 	ofTranslate(16,offset);
@@ -304,7 +642,7 @@ void ofApp::plotLogAverages(vector<float>& buffer, float height, float offset)
     ofNoFill();
     ofDrawRectangle(0, 0, buffer.size()*ratio, height);
 
-    for(unsigned int i = 0; i < log_averages.size(); i++)
+    for(unsigned int i = 0; i < frame.bands.size(); i++)
     {
         float centerFrequency = getLogAverageCentreFreq(i);
         // how wide is this average in Hz?
@@ -323,7 +661,7 @@ void ofApp::plotLogAverages(vector<float>& buffer, float height, float offset)
         int xl = (int)fft->getBinFromFrequency(lowFreq,sampleRate);
         int xr = (int)fft->getBinFromFrequency(highFreq,sampleRate);
 
-        ofDrawRectangle( xl*ratio, height - log_averages[i]*height, (xr-xl)*ratio, log_averages[i]*height );
+        ofDrawRectangle( xl*ratio, height - frame.bands[i]*height, (xr-xl)*ratio, frame.bands[i]*height );
     }
 
     ofPopMatrix();
@@ -331,8 +669,9 @@ void ofApp::plotLogAverages(vector<float>& buffer, float height, float offset)
 }
 
 //--------------------------------------------------------------
-void ofApp::plotLinLogAverages(vector<float>& buffer, float height, float offset)
+void ofApp::plotLinLogAverages(const ClamourAnalysis& frame, float height, float offset)
 {
+    const vector<float>& buffer = frame.spectrum;
     ofPushStyle();
     ofPushMatrix();
 	ofTranslate(16,offset);
@@ -344,8 +683,8 @@ void ofApp::plotLinLogAverages(vector<float>& buffer, float height, float offset
     ofNoFill();
     ofDrawRectangle(0, 0, buffer.size()*ratio, height);
 
-	int w = int( buffer.size()/log_averages.size());
-    for(unsigned int i = 0; i < log_averages.size(); i++)
+	int w = int( buffer.size()/frame.bands.size());
+    for(unsigned int i = 0; i < frame.bands.size(); i++)
     {
         float centerFrequency = getLogAverageCentreFreq(i);
         // how wide is this average in Hz?
@@ -364,7 +703,7 @@ void ofApp::plotLinLogAverages(vector<float>& buffer, float height, float offset
         //int xl = (int)fft->getBinFromFrequency(lowFreq,sampleRate);
         //int xr = (int)fft->getBinFromFrequency(highFreq,sampleRate);
 
-        ofDrawRectangle(i*w*ratio, height - log_averages[i]*height, w*ratio, log_averages[i]*height );
+        ofDrawRectangle(i*w*ratio, height - frame.bands[i]*height, w*ratio, frame.bands[i]*height );
         if(centerFrequency < 1000.0f)
             ofDrawBitmapString(ofToString((int)centerFrequency),(i*w+2)*ratio,height+10);
         else
@@ -437,7 +776,7 @@ float ofApp::calcAvg(float lowFreq, float hiFreq)
     float avg = 0;
     for (int i = lowBound; i <= hiBound; i++)
     {
-      avg += drawBins[i];
+      avg += analysisBins[i];
     }
     avg /= (float)(hiBound - lowBound + 1);
     return avg;
@@ -536,58 +875,16 @@ void ofApp::setupLogAverages(int minBandwidth, int bandsPerOctave)
     log_averages.resize(octaves * bandsPerOctave);
   }
 
-//--------------------------------------------------------------
-void ofApp::sendSerialData()
-{
-    //To verify data, set bVerifyData=true and send data back via Arduino. Note this is for debugging purposes only
-    bVerifyData = false;
-
-    if(bVerifyData) {
-        unsigned char bytesReturned[30];
-        int nRead  = 0;
-        nRead = serial.readBytes( bytesReturned, 30);
-        if(nRead == OF_SERIAL_NO_DATA) {
-            ofLogNotice() << ".... OF_SERIAL_NO_DATA";
-        } else {
-            cout << "Read: " << nRead << " bytes: " << std::flush;
-            for(int i = 0; i < nRead;i++)
-            {
-                 cout << " " << (int) bytesReturned[i] << std::flush;
-            }
-            cout << endl;
-        }
-        ofLogNotice() << "----------------------------------------------------------------------------------------------";
-    }
-
-    for(int i = 0; i < log_averages.size(); i++)
-    {
-        buf[i] = (unsigned char)(ofClamp(log_averages[i],0.0f,1.0f)*255);
-    }
-
-    long val = serial.writeBytes(buf,log_averages.size());
-    if(val == OF_SERIAL_ERROR) {
-        ofLogError() << "Error writing FFT data...";
-    } else {
-        ofLogVerbose() << "Wrote " << val << " bytes.";
-    }
-
-    if(bVerifyData) {
-        cout << "Sent: " << log_averages.size() << " bytes: " << std::flush;
-        for(int i = 0; i < log_averages.size(); i++)
-        {
-            cout << " " << (int)buf[i] << std::flush;
-        }
-        cout << endl;
-    }
-}
-
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
-    if(key == '[') numLinearAverages--;
-    if(key == ']') numLinearAverages++;
-    if(numLinearAverages < 1) numLinearAverages = 1;
-    if(numLinearAverages > fft->getBinSize()) numLinearAverages = fft->getBinSize();
-    setupLinearAverages(numLinearAverages);
+    lastInteractionMicros = ofGetElapsedTimeMicros();
+    // The analysis thread resizes the averages before its next block
+    int numAvg = numLinearAverages;
+    if(key == '[') numAvg--;
+    if(key == ']') numAvg++;
+    if(numAvg < 1) numAvg = 1;
+    if(numAvg > fft->getBinSize() / 2) numAvg = fft->getBinSize() / 2;
+    numLinearAverages = numAvg;
 }
 
 //--------------------------------------------------------------
@@ -599,17 +896,17 @@ void ofApp::keyReleased(int key){
 
 //--------------------------------------------------------------
 void ofApp::mouseMoved(int x, int y ){
-
+    lastInteractionMicros = ofGetElapsedTimeMicros();
 }
 
 //--------------------------------------------------------------
 void ofApp::mouseDragged(int x, int y, int button){
-
+    lastInteractionMicros = ofGetElapsedTimeMicros();
 }
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button){
-
+    lastInteractionMicros = ofGetElapsedTimeMicros();
 }
 
 //--------------------------------------------------------------
@@ -3,7 +3,12 @@
 #include "ofMain.h"
 #include "ofxFft.h"
 #include "ofxGui.h"
-#include "ofxOsc.h"
+#include "FrameBroadcaster.h"
+#include "FrameSinks.h"
+#include "SpectralFeatures.h"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 class ofApp : public ofBaseApp{
 
@@ -26,10 +31,10 @@ class ofApp : public ofBaseApp{
 		void audioReceived(float* input, int bufferSize, int nChannels);
 
         void setupAudio();
-		void plotFFT(vector<float>& buffer, float scale, float offset);
-		void plotLinearAverages(vector<float>& buffer, float scale, float offset);
-		void plotLogAverages(vector<float>& buffer, float height, float offset);
-		void plotLinLogAverages(vector<float>& buffer, float height, float offset);
+		void plotFFT(const ClamourAnalysis& frame, float scale, float offset);
+		void plotLinearAverages(const ClamourAnalysis& frame, float scale, float offset);
+		void plotLogAverages(const ClamourAnalysis& frame, float height, float offset);
+		void plotLinLogAverages(const ClamourAnalysis& frame, float height, float offset);
 		void doLinearAverage(vector<float>& spectrum);
 		void doLogAverage(vector<float>& spectrum);
 		void setupLinearAverages(int numAvg);
@@ -42,14 +47,54 @@ class ofApp : public ofBaseApp{
         void setupGui();
         void setupFFT();
         void setupXmlSettings();
-        void sendSerialData();
+        void setupOutputs();
+        void queueBlock(uint64_t samplePosition, uint64_t captureMicros, float rms, bool bSilent);
+        void analysisLoop();
+        void analyseBlock(bool bSilent);
+        ClamourAnalysisPtr analyseSpectrum();
+        unsigned int getEnabledFeatures();
+        void publishFrame(const ClamourAnalysisPtr& analysis, bool bSilent);
+        void setupIdleMode();
+        void updateIdleState();
+        void updateIdleStats();
+        void detectStaticSpectrum();
+        bool isWindowHidden();
+        bool isSilentBlock(float rms, float peak);
 
         ofSoundStream soundStream;
         int bufferSize;
         ofxFft* fft;
 
         ofMutex soundMutex;
-        vector<float> drawBins, middleBins, audioBins;
+        vector<float> analysisBins, middleBins, audioBins;
+
+        // Stamped blocks from audioReceived to the analysis thread, guarded by soundMutex
+        struct AnalysisBlock {
+            vector<float> bins;             // not copied for silent blocks
+            bool bSilent;
+            uint64_t sequence;
+            uint64_t samplePosition;
+            uint64_t captureMicros;
+            float rms;
+        };
+        vector<AnalysisBlock> blockRing;
+        uint64_t blockRingWrite, blockRingRead;
+
+        // Analysis thread, woken by audioReceived for every block
+        std::thread analysisThread;
+        std::condition_variable analysisWake;
+        bool bAnalysisRunning;              // guarded by soundMutex
+
+        // Frame timing
+        uint64_t samplesCaptured;           // audio thread only
+        uint64_t blockSequence;             // audio thread only
+        std::atomic<uint64_t> droppedBlocks;
+        uint64_t analysisSequence, analysisSamplePosition, analysisCaptureMicros;
+        float analysisRms;
+
+        // Re-stamped for every block of a silent run, analysis thread only
+        ClamourAnalysisPtr zeroAnalysis;
+        unsigned int zeroFeatures;
         int plotHeight;
 
         vector<float> averages;
@@ -58,31 +103,75 @@ class ofApp : public ofBaseApp{
         int avgPerOctave;
         int sampleRate;
         float bandWidth;
-        int numLinearAverages;
+        std::atomic<int> numLinearAverages;
 
         float ratio;
 
+        SpectralFeatureExtractor featureExtractor;
+
         // GUI
         ofxPanel gui;
         vector<ofParameter<float>> sliders;
         ofParameter<float> gain;        
+        ofParameterGroup featureParams;
+        ofParameter<bool> bCentroid;
+        ofParameter<bool> bRolloff;
+        ofParameter<bool> bFlatness;
+        ofParameter<bool> bFlux;
+        ofParameter<bool> bEnergy;
+        ofParameter<bool> bRms;
         int plotType;
         ofColor background;
         ofColor foreground;
 
+        // Outputs
+        FrameBroadcaster broadcaster;
+        shared_ptr<GuiSink> guiSink;
+
         // Serial comms
-        ofSerial serial;
-        bool bIsSerialSetup;
+        shared_ptr<SerialSink> serialSink;
         ofParameter<bool> bSendSerial;
         int baudRate;
-        unsigned char buf[30];
-        bool bVerifyData;
+        string serialPortName;
 
         //OSC
-        ofxOscSender osc;
+        shared_ptr<OscSink> oscSink;
         ofParameter<bool> bSendOSC;
-        string serialPortName;
 
         //XML
         ofXml xml;
+
+        // Idle mode
+        ofParameter<bool> bIdleMode;
+        ofParameter<float> gateThreshold;   // dBFS, after gain
+        int fullFrameRate;
+        int idleFrameRate;
+        int gateHoldLength;                 // audio blocks the gate stays open after signal drops
+        int gateHoldBlocks;                 // audio thread only
+        std::atomic<bool> bGateOpen;
+        bool bIdle;
+        bool bWakeRender;
+        std::mutex idleMutex;
+        std::condition_variable idleWake;
+        uint64_t lastInteractionMicros;
+
+        vector<float> lastAnalysisBins;
+        int staticFrames;                   // analysis thread only
+        bool bSpectrumStatic;               // analysis thread only
+        std::atomic<bool> bSpectrumActive;  // gate open and spectrum changing
+
+        // Idle stats
+        std::atomic<uint64_t> analysedBlocks;
+        std::atomic<uint64_t> gatedBlocks;
+        std::atomic<float> fftMicros;       // smoothed cost of one FFT block
+        std::atomic<float> analysisMicros;  // smoothed cost of analysing and publishing one block
+        float frameMicros;                  // smoothed busy time of update() + draw()
+        float idleSkippedFrames;            // frames not drawn while idle since the last stats update
+        uint64_t frameStartMicros;
+        uint64_t statsLastMicros;
+        uint64_t statsLastGated;
+        uint64_t statsLastAnalysed;
+        float gatedPercent;
+        float cpuSavedPercent;
+        double totalSavedMicros;
 };